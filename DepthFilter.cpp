@@ -0,0 +1,198 @@
+#include "DepthFilter.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define C_DEPTH_FILTER_SSE2
+#include <emmintrin.h>
+#endif
+
+// fixed point precision of the temporal weight
+#define C_DEPTH_WEIGHT_BITS 8
+#define C_DEPTH_WEIGHT_ONE (1 << C_DEPTH_WEIGHT_BITS)
+
+// Minimum non-zero value of the 3x3 neighbourhood around x, 0 if every pixel is a hole
+static inline ushort minValid(const ushort* r0, const ushort* r1, const ushort* r2, int x, int cols)
+{
+	int xl = std::max(x - 1, 0);
+	int xr = std::min(x + 1, cols - 1);
+	// subtracting one wraps holes to the largest value, so a plain min skips them
+	ushort m = 0xFFFF;
+	m = std::min(m, (ushort)(r0[xl] - 1)); m = std::min(m, (ushort)(r0[x] - 1)); m = std::min(m, (ushort)(r0[xr] - 1));
+	m = std::min(m, (ushort)(r1[xl] - 1)); m = std::min(m, (ushort)(r1[x] - 1)); m = std::min(m, (ushort)(r1[xr] - 1));
+	m = std::min(m, (ushort)(r2[xl] - 1)); m = std::min(m, (ushort)(r2[x] - 1)); m = std::min(m, (ushort)(r2[xr] - 1));
+	return (ushort)(m + 1);
+}
+
+static inline ushort filterPixel(const ushort* r0, const ushort* r1, const ushort* r2, ushort prev, uchar& age, int x, int cols, int weight, int motionThreshold, int holeFrames)
+{
+	ushort cur = r1[x] ? r1[x] : minValid(r0, r1, r2, x, cols);
+	if (cur == 0)
+	{
+		// bridge short dropouts with the history, forget it once the hole persists
+		age = (uchar)std::min(age + 1, 255);
+		return age > holeFrames ? 0 : prev;
+	}
+	age = 0;
+	if (prev == 0 || std::abs((int)cur - (int)prev) > motionThreshold)
+	{
+		return cur;
+	}
+	return (ushort)((cur * weight + prev * (C_DEPTH_WEIGHT_ONE - weight) + C_DEPTH_WEIGHT_ONE / 2) >> C_DEPTH_WEIGHT_BITS);
+}
+
+#ifdef C_DEPTH_FILTER_SSE2
+static inline __m128i minEpu16(__m128i a, __m128i b)
+{
+	// SSE2 has no unsigned 16 bit min, a - max(a - b, 0) is the same thing
+	return _mm_sub_epi16(a, _mm_subs_epu16(a, b));
+}
+
+static inline __m128i loadMinusOne(const ushort* p, __m128i one)
+{
+	return _mm_sub_epi16(_mm_loadu_si128((const __m128i*)p), one);
+}
+#endif
+
+class DepthFilterBody : public cv::ParallelLoopBody
+{
+	const cv::Mat& m_raw;
+	cv::Mat& m_history;
+	cv::Mat& m_holeAge;
+	cv::Mat& m_filtered;
+	int m_weight;
+	int m_motionThreshold;
+	int m_holeFrames;
+public:
+	DepthFilterBody(const cv::Mat& raw, cv::Mat& history, cv::Mat& holeAge, cv::Mat& filtered, int weight, int motionThreshold, int holeFrames)
+		: m_raw(raw), m_history(history), m_holeAge(holeAge), m_filtered(filtered), m_weight(weight), m_motionThreshold(motionThreshold), m_holeFrames(holeFrames)
+	{
+	}
+
+	void operator()(const cv::Range& range) const
+	{
+		int rows = m_raw.rows;
+		int cols = m_raw.cols;
+
+		for (int y = range.start; y < range.end; y++)
+		{
+			// border rows reuse themselves as the missing neighbour
+			const ushort* r0 = m_raw.ptr<ushort>(std::max(y - 1, 0));
+			const ushort* r1 = m_raw.ptr<ushort>(y);
+			const ushort* r2 = m_raw.ptr<ushort>(std::min(y + 1, rows - 1));
+			ushort* hist = m_history.ptr<ushort>(y);
+			uchar* age = m_holeAge.ptr<uchar>(y);
+			ushort* out = m_filtered.ptr<ushort>(y);
+
+			int x = 0;
+			if (cols > 0)
+			{
+				hist[0] = out[0] = filterPixel(r0, r1, r2, hist[0], age[0], 0, cols, m_weight, m_motionThreshold, m_holeFrames);
+				x = 1;
+			}
+
+#ifdef C_DEPTH_FILTER_SSE2
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i one = _mm_set1_epi16(1);
+			const __m128i sign = _mm_set1_epi16((short)0x8000);
+			const __m128i threshold = _mm_set1_epi16((short)m_motionThreshold);
+			const __m128i holeFrames = _mm_set1_epi16((short)m_holeFrames);
+			// pairs of (new, history) weights for madd, both operands biased into signed range
+			const __m128i weights = _mm_set1_epi32(((C_DEPTH_WEIGHT_ONE - m_weight) << 16) | m_weight);
+			const __m128i rounding = _mm_set1_epi32(C_DEPTH_WEIGHT_ONE / 2);
+
+			// 8 pixels per step, the right neighbour of the last one must still be inside the row
+			for (; x + 9 <= cols; x += 8)
+			{
+				__m128i raw = _mm_loadu_si128((const __m128i*)(r1 + x));
+				__m128i prev = _mm_loadu_si128((const __m128i*)(hist + x));
+
+				// spatial hole filling
+				__m128i m = loadMinusOne(r0 + x - 1, one);
+				m = minEpu16(m, loadMinusOne(r0 + x, one));
+				m = minEpu16(m, loadMinusOne(r0 + x + 1, one));
+				m = minEpu16(m, loadMinusOne(r1 + x - 1, one));
+				m = minEpu16(m, _mm_sub_epi16(raw, one));
+				m = minEpu16(m, loadMinusOne(r1 + x + 1, one));
+				m = minEpu16(m, loadMinusOne(r2 + x - 1, one));
+				m = minEpu16(m, loadMinusOne(r2 + x, one));
+				m = minEpu16(m, loadMinusOne(r2 + x + 1, one));
+				m = _mm_add_epi16(m, one);
+
+				__m128i rawHole = _mm_cmpeq_epi16(raw, zero);
+				__m128i cur = _mm_or_si128(_mm_and_si128(rawHole, m), _mm_andnot_si128(rawHole, raw));
+
+				// temporal exponential filter, (cur * w + prev * (1 - w)) in fixed point
+				__m128i cs = _mm_xor_si128(cur, sign);
+				__m128i ps = _mm_xor_si128(prev, sign);
+				__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(cs, ps), weights);
+				__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(cs, ps), weights);
+				lo = _mm_srai_epi32(_mm_add_epi32(lo, rounding), C_DEPTH_WEIGHT_BITS);
+				hi = _mm_srai_epi32(_mm_add_epi32(hi, rounding), C_DEPTH_WEIGHT_BITS);
+				__m128i blended = _mm_xor_si128(_mm_packs_epi32(lo, hi), sign);
+
+				// holes keep their history for a few frames, new pixels and real motion take the current depth
+				__m128i curHole = _mm_cmpeq_epi16(cur, zero);
+				__m128i holeAge = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(age + x)), zero);
+				holeAge = _mm_and_si128(curHole, _mm_add_epi16(holeAge, one));
+				__m128i expired = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_subs_epu16(holeAge, holeFrames), zero), curHole);
+				__m128i prevHole = _mm_cmpeq_epi16(prev, zero);
+				__m128i diff = _mm_or_si128(_mm_subs_epu16(cur, prev), _mm_subs_epu16(prev, cur));
+				__m128i still = _mm_cmpeq_epi16(_mm_subs_epu16(diff, threshold), zero);
+				__m128i takeCur = _mm_andnot_si128(curHole, _mm_or_si128(prevHole, _mm_andnot_si128(still, _mm_cmpeq_epi16(zero, zero))));
+
+				__m128i result = _mm_or_si128(_mm_and_si128(takeCur, cur), _mm_andnot_si128(takeCur, blended));
+				result = _mm_or_si128(_mm_and_si128(curHole, prev), _mm_andnot_si128(curHole, result));
+				result = _mm_andnot_si128(expired, result);
+
+				_mm_storeu_si128((__m128i*)(hist + x), result);
+				_mm_storeu_si128((__m128i*)(out + x), result);
+				_mm_storel_epi64((__m128i*)(age + x), _mm_packus_epi16(holeAge, zero));
+			}
+#endif
+
+			for (; x < cols; x++)
+			{
+				hist[x] = out[x] = filterPixel(r0, r1, r2, hist[x], age[x], x, cols, m_weight, m_motionThreshold, m_holeFrames);
+			}
+		}
+	}
+};
+
+DepthFilter::DepthFilter(double smoothing, int motionThreshold, int holeFrames)
+{
+	m_weight = cv::saturate_cast<int>(smoothing * C_DEPTH_WEIGHT_ONE);
+	m_weight = std::min(std::max(m_weight, 0), C_DEPTH_WEIGHT_ONE);
+	m_motionThreshold = std::min(std::max(motionThreshold, 0), 0xFFFF);
+	// the age counter saturates at 255
+	m_holeFrames = std::min(std::max(holeFrames, 0), 254);
+}
+
+void DepthFilter::apply(const cv::Mat& raw, cv::Mat& filtered)
+{
+	CV_Assert(raw.type() == CV_16UC1);
+
+	if (m_history.size() != raw.size())
+	{
+		m_history = cv::Mat::zeros(raw.size(), CV_16UC1);
+		m_holeAge = cv::Mat::zeros(raw.size(), CV_8UC1);
+	}
+	if (filtered.data == raw.data)
+	{
+		filtered = cv::Mat();
+	}
+	filtered.create(raw.size(), CV_16UC1);
+
+	cv::parallel_for_(cv::Range(0, raw.rows), DepthFilterBody(raw, m_history, m_holeAge, filtered, m_weight, m_motionThreshold, m_holeFrames), cv::getNumThreads());
+}
+
+void DepthFilter::reset()
+{
+	m_history.release();
+	m_holeAge.release();
+}
+
+DepthFilter::~DepthFilter(void)
+{
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <opencv2/core/core.hpp>
+
+// default weight of the newest frame in the temporal filter, 0 (frozen) .. 1 (no smoothing)
+#define C_DEPTH_SMOOTHING 0.5
+// depth change in mm between frames treated as real motion instead of sensor flicker
+#define C_DEPTH_MOTION_THRESHOLD 100
+// frames a pixel may stay a hole and still report its last valid depth
+#define C_DEPTH_HOLE_FRAMES 5
+
+// Cleans up raw CV_16UC1 depth before it is segmented or deprojected.
+// Zero readings are filled with the nearest valid depth in their 3x3 neighbourhood
+// (a min over valid pixels, so holes take the foreground side of an edge), then each
+// pixel is blended with its history by an exponential filter. Large jumps reset the
+// history so moving objects do not smear. Pixels that are still holes keep their last
+// valid depth for up to holeFrames frames, then drop back to 0.
+// Runs as SSE2 uint16 kernels over parallel row bands.
+class DepthFilter
+{
+	cv::Mat m_history;
+	cv::Mat m_holeAge;
+	int m_weight;
+	int m_motionThreshold;
+	int m_holeFrames;
+public:
+	DepthFilter(double smoothing = C_DEPTH_SMOOTHING, int motionThreshold = C_DEPTH_MOTION_THRESHOLD, int holeFrames = C_DEPTH_HOLE_FRAMES);
+	// filtered must not share data with raw; it is reallocated if it does
+	void apply(const cv::Mat& raw, cv::Mat& filtered);
+	void reset();
+	~DepthFilter(void);
+};
@@ -29,6 +29,7 @@ OpenCVKinect::OpenCVKinect(void)
 {
 	m_depthTimeStamp = 0;
 	m_colorTimeStamp = 0;
+	m_filteredTimeStamp = 0;
 }
 
 bool OpenCVKinect::init()
@@ -114,6 +115,17 @@ bool OpenCVKinect::read(cv::Mat& returnImage, ImageType type)
 		std::cout << "OpenCVKinect: Unable to wait for streams. Exiting" << std::endl;
 		return false;
 	}
+
+	// keep the depth filter running on every depth frame, even when only color is requested
+	if (m_currentStream == C_DEPTH_STREAM && type != ImageType::DEPTH)
+	{
+		openni::VideoFrameRef m_depthFrame;
+		m_depth.readFrame(&m_depthFrame);
+		this->m_depthTimeStamp = m_depthFrame.getTimestamp() >> 16;
+		filterDepth(m_depthFrame);
+		m_depthFrame.release();
+	}
+
 	cv::Mat bufferImage;
 	switch (type)
 	{
@@ -134,10 +146,11 @@ bool OpenCVKinect::read(cv::Mat& returnImage, ImageType type)
 		{
 			openni::VideoFrameRef m_depthFrame;
 			m_depth.readFrame(&m_depthFrame);
-			returnImage.create(m_depthFrame.getHeight(), m_depthFrame.getWidth(), CV_16UC1);
-			returnImage.data = (uchar*)m_depthFrame.getData();
 			this->m_depthTimeStamp = m_depthFrame.getTimestamp() >> 16;
 			std::cout << "Depth Timestamp: " << this->m_depthTimeStamp << std::endl;
+			filterDepth(m_depthFrame);
+			// deep copy, the cached depth must stay intact for distanceToPixel
+			returnImage = m_filteredDepth.clone();
 			m_depthFrame.release();
 			break;
 		}
@@ -146,13 +159,36 @@ bool OpenCVKinect::read(cv::Mat& returnImage, ImageType type)
 	return true;
 }
 
+// Hole filling and temporal smoothing of the raw depth, done once per depth frame
+void OpenCVKinect::filterDepth(openni::VideoFrameRef& depthFrame)
+{
+	if (!m_filteredDepth.empty() && depthFrame.getTimestamp() == m_filteredTimeStamp)
+	{
+		return;
+	}
+	cv::Mat rawDepth(depthFrame.getHeight(), depthFrame.getWidth(), CV_16UC1, (void*)depthFrame.getData(), depthFrame.getStrideInBytes());
+	m_depthFilter.apply(rawDepth, m_filteredDepth);
+	m_filteredTimeStamp = depthFrame.getTimestamp();
+}
+
+// Deprojects against the most recently filtered depth frame, which read() keeps current
 openni::Status OpenCVKinect::distanceToPixel(int x, int y, float& wx, float& wy, float& wz)
 {
-	openni::VideoFrameRef m_depthFrame;
-	m_depth.readFrame(&m_depthFrame);
-	openni::DepthPixel* pDepth = (openni::DepthPixel*) m_depthFrame.getData();
-	int pos = y * m_depthFrame.getWidth() + x;
-	return openni::CoordinateConverter::convertDepthToWorld(m_depth, x, y, pDepth[pos], &wx, &wy, &wz);
+	if (m_filteredDepth.empty())
+	{
+		return openni::STATUS_ERROR;
+	}
+	if (x < 0 || y < 0 || x >= m_filteredDepth.cols || y >= m_filteredDepth.rows)
+	{
+		return openni::STATUS_BAD_PARAMETER;
+	}
+	openni::DepthPixel depth = m_filteredDepth.at<openni::DepthPixel>(y, x);
+	if (depth == 0)
+	{
+		// still a hole after filtering, there is no depth to convert
+		return openni::STATUS_ERROR;
+	}
+	return openni::CoordinateConverter::convertDepthToWorld(m_depth, x, y, depth, &wx, &wy, &wz);
 }
 
 openni::Status OpenCVKinect::registerDepthAndImage()
@@ -31,6 +31,7 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <vector>
 #include <iostream>
+#include "DepthFilter.h"
 
 #define C_DEPTH_STREAM 0
 #define C_COLOR_STREAM 1
@@ -54,7 +55,10 @@ class OpenCVKinect
 	openni::Device m_device;
 	openni::VideoStream m_depth, m_color, **m_streams;
 	int m_currentStream;
-	uint64_t m_depthTimeStamp, m_colorTimeStamp;
+	uint64_t m_depthTimeStamp, m_colorTimeStamp, m_filteredTimeStamp;
+	DepthFilter m_depthFilter;
+	cv::Mat m_filteredDepth;
+	void filterDepth(openni::VideoFrameRef& depthFrame);
 public:
 	OpenCVKinect(void);
 	bool read(cv::Mat& returnVec, ImageType type);
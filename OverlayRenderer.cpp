@@ -0,0 +1,203 @@
+#include "OverlayRenderer.h"
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// member-wise swap, so handing a snapshot between threads never deep-copies its vectors
+static void swapSnapshots(OverlaySnapshot& a, OverlaySnapshot& b)
+{
+	cv::swap(a.frame, b.frame);
+	a.frameWindow.swap(b.frameWindow);
+	a.images.swap(b.images);
+	std::swap(a.status, b.status);
+	a.objects.swap(b.objects);
+	a.contours.swap(b.contours);
+	a.hierarchy.swap(b.hierarchy);
+	a.markers.swap(b.markers);
+}
+
+void OverlayTrackbar::create(const std::string& name, const std::string& window, int count)
+{
+	cv::createTrackbar(name, window, &position, count, &OverlayTrackbar::onChange, this);
+}
+
+void OverlayTrackbar::onChange(int pos, void* userdata)
+{
+	((OverlayTrackbar*)userdata)->value = pos;
+}
+
+OverlayRenderer::OverlayRenderer(double displayRate)
+	: m_displayRate(displayRate > 0 ? displayRate : C_DISPLAY_RATE), m_hasPending(false), m_rng(12345)
+{
+	m_running = false;
+	m_escPressed = false;
+	m_dropped = 0;
+}
+
+void OverlayRenderer::start(std::function<void()> setupWindows)
+{
+	if (m_running)
+	{
+		return;
+	}
+	m_running = true;
+	m_thread = std::thread(&OverlayRenderer::run, this, setupWindows);
+}
+
+void OverlayRenderer::submit(OverlaySnapshot& snapshot)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_hasPending)
+		{
+			// renderer has not caught up, the older snapshot is never shown
+			m_dropped++;
+		}
+		swapSnapshots(m_pending, snapshot);
+		m_hasPending = true;
+	}
+	m_submitted.notify_one();
+}
+
+bool OverlayRenderer::stopRequested() const
+{
+	return m_escPressed;
+}
+
+unsigned long OverlayRenderer::droppedFrames() const
+{
+	return m_dropped;
+}
+
+void OverlayRenderer::run(std::function<void()> setupWindows)
+{
+	if (setupWindows)
+	{
+		setupWindows();
+	}
+
+	const std::chrono::milliseconds period((long long)(1000.0 / m_displayRate));
+	const std::chrono::milliseconds eventInterval(std::min<long long>(period.count(), C_EVENT_INTERVAL));
+	std::chrono::steady_clock::time_point nextFrame = std::chrono::steady_clock::now();
+	OverlaySnapshot current;
+
+	while (m_running)
+	{
+		bool haveFrame = false;
+		if (std::chrono::steady_clock::now() >= nextFrame)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			// sleep until detection submits something instead of spinning on waitKey,
+			// but wake up often enough to keep the windows and trackbars responsive
+			if (!m_hasPending)
+			{
+				m_submitted.wait_for(lock, eventInterval);
+			}
+			if (m_hasPending)
+			{
+				swapSnapshots(current, m_pending);
+				m_hasPending = false;
+				haveFrame = true;
+			}
+		}
+
+		if (haveFrame)
+		{
+			draw(current);
+			nextFrame = std::chrono::steady_clock::now() + period;
+		}
+
+		// waitKey doubles as the frame limiter and pumps the window events
+		long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(nextFrame - std::chrono::steady_clock::now()).count();
+		int delay = (int)std::max<long long>(1, std::min<long long>(remaining, period.count()));
+		if (cv::waitKey(delay) == 27) //'esc' key
+		{
+			std::cout << "esc key is pressed by user" << std::endl;
+			m_escPressed = true;
+		}
+	}
+	cv::destroyAllWindows();
+}
+
+void OverlayRenderer::draw(OverlaySnapshot& snapshot)
+{
+	for (size_t i = 0; i < snapshot.images.size(); i++)
+	{
+		cv::imshow(snapshot.images[i].first, snapshot.images[i].second);
+	}
+
+	if (snapshot.frame.empty())
+	{
+		return;
+	}
+
+	// producers hand over ownership of the frame, so the overlay goes straight into it
+	cv::Mat& dst = snapshot.frame;
+	switch (snapshot.status)
+	{
+	case TRACKING:
+		{
+			cv::putText(dst, "Tracking Object", cv::Point(0, 50), 2, 1, cv::Scalar(0, 255, 0), 2);
+			for (int i = 0; i < (int)snapshot.contours.size(); i++)
+			{
+				cv::Scalar color = cv::Scalar(m_rng.uniform(0, 255), m_rng.uniform(0, 255), m_rng.uniform(0, 255));
+				cv::drawContours(dst, snapshot.contours, i, color, 2, 8, snapshot.hierarchy, 0, cv::Point());
+			}
+			break;
+		}
+	case TOO_NOISY:
+		{
+			cv::putText(dst, "TOO MUCH NOISE! ADJUST FILTER", cv::Point(0, 50), 1, 2, cv::Scalar(0, 0, 255), 2);
+			break;
+		}
+	default:
+		break;
+	}
+
+	for (size_t i = 0; i < snapshot.objects.size(); i++)
+	{
+		drawObject(snapshot.objects[i], dst);
+	}
+	for (size_t i = 0; i < snapshot.markers.size(); i++)
+	{
+		cv::line(dst, snapshot.markers[i], snapshot.markers[i], cv::Scalar(0, 0, 255), 4);
+	}
+	cv::imshow(snapshot.frameWindow, dst);
+}
+
+void OverlayRenderer::drawObject(const OverlayObject& object, cv::Mat& frame)
+{
+	int x = object.center.x;
+	int y = object.center.y;
+
+	// crosshairs clamped to the frame borders
+	cv::circle(frame, cv::Point(x, y), 20, cv::Scalar(0, 255, 0), 2);
+	cv::line(frame, cv::Point(x, y), cv::Point(x, std::max(y - 25, 0)), cv::Scalar(0, 255, 0), 2);
+	cv::line(frame, cv::Point(x, y), cv::Point(x, std::min(y + 25, frame.rows)), cv::Scalar(0, 255, 0), 2);
+	cv::line(frame, cv::Point(x, y), cv::Point(std::max(x - 25, 0), y), cv::Scalar(0, 255, 0), 2);
+	cv::line(frame, cv::Point(x, y), cv::Point(std::min(x + 25, frame.cols), y), cv::Scalar(0, 255, 0), 2);
+	cv::putText(frame, cv::format("%d,%d", x, y), cv::Point(x, y + 30), 1, 1, cv::Scalar(0, 255, 0), 2);
+
+	if (object.hasWorld)
+	{
+		cv::putText(frame, cv::format("%g,%g,%g", object.world.x, object.world.y, object.world.z), cv::Point(0, 50), 1, 2, cv::Scalar(0, 0, 255), 1);
+	}
+}
+
+void OverlayRenderer::stop()
+{
+	m_running = false;
+	m_submitted.notify_one();
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+OverlayRenderer::~OverlayRenderer(void)
+{
+	stop();
+}
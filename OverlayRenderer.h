@@ -0,0 +1,97 @@
+#pragma once
+#include <opencv2/core/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// default number of overlay frames drawn and shown per second
+#define C_DISPLAY_RATE 30
+// longest time in ms the render thread goes without servicing window events
+#define C_EVENT_INTERVAL 30
+
+enum OverlayStatus
+{
+	NO_OBJECT,
+	TRACKING,
+	TOO_NOISY
+};
+
+// A tracked object as reported by the processing loop
+struct OverlayObject
+{
+	cv::Point center;
+	bool hasWorld;
+	cv::Point3f world;
+
+	OverlayObject(cv::Point c) : center(c), hasWorld(false) {}
+};
+
+// Everything the renderer needs to draw one frame. Images are shared, not copied:
+// the renderer draws the overlay straight into frame, so the producer must not touch
+// any submitted image again and should allocate fresh ones for the next snapshot.
+struct OverlaySnapshot
+{
+	cv::Mat frame;
+	std::string frameWindow;
+	std::vector< std::pair<std::string, cv::Mat> > images;
+
+	OverlayStatus status;
+	std::vector<OverlayObject> objects;
+	std::vector< std::vector<cv::Point> > contours;
+	std::vector<cv::Vec4i> hierarchy;
+	std::vector<cv::Point> markers;
+
+	OverlaySnapshot() : status(NO_OBJECT) {}
+};
+
+// Trackbar whose position is written by HighGUI on the render thread and mirrored
+// into an atomic, so the processing loop reads value without racing the GUI
+struct OverlayTrackbar
+{
+	int position;
+	std::atomic<int> value;
+
+	OverlayTrackbar(int initial) : position(initial) { value = initial; }
+	// call from the setupWindows function passed to OverlayRenderer::start
+	void create(const std::string& name, const std::string& window, int count);
+	static void onChange(int pos, void* userdata);
+};
+
+// Draws detections and owns all HighGUI windows on its own thread.
+// The processing loop hands over the latest snapshot with submit(); the renderer
+// draws at most displayRate frames per second and drops any snapshot it has not
+// picked up before the next one arrives, so it never stalls detection.
+class OverlayRenderer
+{
+	double m_displayRate;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_submitted;
+	OverlaySnapshot m_pending;
+	bool m_hasPending;
+	std::atomic<bool> m_running, m_escPressed;
+	std::atomic<unsigned long> m_dropped;
+	cv::RNG m_rng;
+
+	void run(std::function<void()> setupWindows);
+	void draw(OverlaySnapshot& snapshot);
+	void drawObject(const OverlayObject& object, cv::Mat& frame);
+public:
+	OverlayRenderer(double displayRate = C_DISPLAY_RATE);
+	// setupWindows runs on the render thread, so windows and trackbars created there
+	// are serviced by its event loop
+	void start(std::function<void()> setupWindows);
+	// takes the contents of snapshot without copying; snapshot comes back holding
+	// stale data from an earlier frame and should be discarded
+	void submit(OverlaySnapshot& snapshot);
+	bool stopRequested() const;
+	// number of snapshots replaced before the renderer got to draw them
+	unsigned long droppedFrames() const;
+	void stop();
+	~OverlayRenderer(void);
+};
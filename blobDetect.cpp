@@ -1,4 +1,5 @@
 #include "OpenCVKinect.h"
+#include "OverlayRenderer.h"
 
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
@@ -18,60 +19,7 @@ const int MAX_NUM_OBJECTS = 50;
 const double MIN_OBJECT_AREA = 20 * 20;
 const double MAX_OBJECT_AREA = FRAME_HEIGHT * FRAME_WIDTH / 1.5;
 
-RNG rng(12345);
-
-string intToString(int number)
-{
-	stringstream ss;
-	ss << number;
-	return ss.str();
-}
-
-void drawObject(int x, int y, Mat& frame)
-{
-	//use some of the openCV drawing functions to draw crosshairs on your tracked image!
-	circle(frame, Point(x, y), 20, Scalar(0, 255, 0), 2);
-	if (y - 25 > 0)
-	{
-		line(frame, Point(x, y), Point(x, y - 25), Scalar(0, 255, 0), 2);
-	}
-	else
-	{
-		line(frame, Point(x, y), Point(x, 0), Scalar(0, 255, 0), 2);
-	}
-
-	if (y + 25 < FRAME_HEIGHT)
-	{
-		line(frame, Point(x, y), Point(x, y + 25), Scalar(0, 255, 0), 2);
-	}
-	else
-	{
-		line(frame, Point(x, y), Point(x, FRAME_HEIGHT), Scalar(0, 255, 0), 2);
-	}
-
-	if (x - 25 > 0)
-	{
-		line(frame, Point(x, y), Point(x - 25, y), Scalar(0, 255, 0), 2);
-	}
-	else
-	{
-		line(frame, Point(x, y), Point(0, y), Scalar(0, 255, 0), 2);
-	}
-
-	if (x + 25 < FRAME_WIDTH)
-	{
-		line(frame, Point(x, y), Point(x + 25, y), Scalar(0, 255, 0), 2);
-	}
-	else
-	{
-		line(frame, Point(x, y), Point(FRAME_WIDTH, y), Scalar(0, 255, 0), 2);
-	}
-
-	putText(frame, intToString(x) + "," + intToString(y), Point(x, y + 30), 1, 1, Scalar(0, 255, 0), 2);
-
-}
-
-void trackFilteredObject(Mat& threshold, Mat& cameraFeed)
+void trackFilteredObject(Mat& threshold, OverlaySnapshot& snapshot)
 {
 	Mat temp;
 	threshold.copyTo(temp); // OpenCV performs a shallow copy to save time and space; copyTo function creates a deep copy
@@ -119,22 +67,17 @@ void trackFilteredObject(Mat& threshold, Mat& cameraFeed)
 			//let user know you found an object
 			if (objectFound == true)
 			{
-				putText(cameraFeed, "Tracking Object", Point(0, 50), 2, 1, Scalar(0, 255, 0), 2);
-				//draw object location on screen
-				drawObject(x, y, cameraFeed);
-
-				for (int i = 0; i< contours.size(); i++)
-				{
-					Scalar color = Scalar(rng.uniform(0, 255), rng.uniform(0, 255), rng.uniform(0, 255));
-					drawContours(cameraFeed, contours, i, color, 2, 8, hierarchy, 0, Point());
-				}
-
+				snapshot.status = TRACKING;
+				//object location and contours are drawn by the renderer
+				snapshot.objects.push_back(OverlayObject(Point(x, y)));
+				snapshot.contours.swap(contours);
+				snapshot.hierarchy.swap(hierarchy);
 			}
 
 		}
 		else
 		{
-			putText(cameraFeed, "TOO MUCH NOISE! ADJUST FILTER", Point(0, 50), 1, 2, Scalar(0, 0, 255), 2);
+			snapshot.status = TOO_NOISY;
 		}
 	}
 }
@@ -149,28 +92,33 @@ int main()
 	}
 	cap.registerDepthAndImage();
 
-	namedWindow("Control", CV_WINDOW_AUTOSIZE); //create a window called "Control"
+	OverlayTrackbar iLowH(0);
+	OverlayTrackbar iHighH(179);
 
-	int iLowH = 0;
-	int iHighH = 179;
+	OverlayTrackbar iLowS(0);
+	OverlayTrackbar iHighS(255);
 
-	int iLowS = 0;
-	int iHighS = 255;
+	OverlayTrackbar iLowV(0);
+	OverlayTrackbar iHighV(255);
 
-	int iLowV = 0;
-	int iHighV = 255;
+	// Windows live on the render thread so drawing and imshow never delay detection
+	OverlayRenderer renderer;
+	renderer.start([&]()
+	{
+		namedWindow("Control", CV_WINDOW_AUTOSIZE); //create a window called "Control"
 
-	//Create trackbars in "Control" window
-	cvCreateTrackbar("LowH", "Control", &iLowH, 179); //Hue (0 - 179)
-	cvCreateTrackbar("HighH", "Control", &iHighH, 179);
+		//Create trackbars in "Control" window
+		iLowH.create("LowH", "Control", 179); //Hue (0 - 179)
+		iHighH.create("HighH", "Control", 179);
 
-	cvCreateTrackbar("LowS", "Control", &iLowS, 255); //Saturation (0 - 255)
-	cvCreateTrackbar("HighS", "Control", &iHighS, 255);
+		iLowS.create("LowS", "Control", 255); //Saturation (0 - 255)
+		iHighS.create("HighS", "Control", 255);
 
-	cvCreateTrackbar("LowV", "Control", &iLowV, 255);//Value (0 - 255)
-	cvCreateTrackbar("HighV", "Control", &iHighV, 255);
+		iLowV.create("LowV", "Control", 255);//Value (0 - 255)
+		iHighV.create("HighV", "Control", 255);
+	});
 
-	while (true)
+	while (!renderer.stopRequested())
 	{
 		// Read Image
 		Mat imgOriginal;
@@ -187,7 +135,7 @@ int main()
 
 		// Binary Min/Max Threshold
 		Mat imgThresholded;
-		inRange(imgHSV, Scalar(iLowH, iLowS, iLowV), Scalar(iHighH, iHighS, iHighV), imgThresholded); //Threshold the image
+		inRange(imgHSV, Scalar(iLowH.value, iLowS.value, iLowV.value), Scalar(iHighH.value, iHighS.value, iHighV.value), imgThresholded); //Threshold the image
 
 		// Morphological Operations to remove background noise
 		// morphological opening (removes small objects from the foreground)
@@ -199,16 +147,16 @@ int main()
 		erode(imgThresholded, imgThresholded, getStructuringElement(MORPH_ELLIPSE, Size(5, 5)));
 
 		// Find Contours and Moments to track object
-		trackFilteredObject(imgThresholded, imgOriginal);
-
-		imshow("Thresholded Image", imgThresholded); //show the thresholded image
-		imshow("Original", imgOriginal); //show the original image
-
-		if (waitKey(30) == 27) //wait for 'esc' key press for 30ms. If 'esc' key is pressed, break loop
-		{
-			cout << "esc key is pressed by user" << endl;
-			break;
-		}
+		OverlaySnapshot snapshot;
+		trackFilteredObject(imgThresholded, snapshot);
+
+		// hand the frame over to the renderer, it is dropped if the display is still busy
+		snapshot.images.push_back(make_pair(string("Thresholded Image"), imgThresholded)); //show the thresholded image
+		snapshot.frame = imgOriginal; //show the original image
+		snapshot.frameWindow = "Original";
+		renderer.submit(snapshot);
 	}
+	renderer.stop();
+	cout << "Overlay frames dropped: " << renderer.droppedFrames() << endl;
 	return 0;
 }
\ No newline at end of file
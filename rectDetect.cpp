@@ -1,4 +1,5 @@
 #include "OpenCVKinect.h"
+#include "OverlayRenderer.h"
 
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
@@ -18,68 +19,15 @@ const int MAX_NUM_OBJECTS = 50;
 const double MIN_OBJECT_AREA = 20 * 20;
 const double MAX_OBJECT_AREA = FRAME_HEIGHT * FRAME_WIDTH / 1.5;
 
-RNG rng(12345);
-
 OpenCVKinect cap;
-int lowThreshold = 50;
+OverlayRenderer renderer;
+OverlayTrackbar lowThreshold(50);
 int const maxLowThreshold = 100;
 int ratio = 3;
 int kernel_size = 3;
 
-template<typename Type>
-string numToString(Type number)
-{
-	stringstream ss;
-	ss << number;
-	return ss.str();
-}
-
-void drawObject(int x, int y, Mat& frame)
-{
-	//use some of the openCV drawing functions to draw crosshairs on your tracked image!
-	circle(frame, Point(x, y), 20, Scalar(0, 255, 0), 2);
-	if (y - 25 > 0)
-	{
-		line(frame, Point(x, y), Point(x, y - 25), Scalar(0, 255, 0), 2);
-	}
-	else
-	{
-		line(frame, Point(x, y), Point(x, 0), Scalar(0, 255, 0), 2);
-	}
-
-	if (y + 25 < FRAME_HEIGHT)
-	{
-		line(frame, Point(x, y), Point(x, y + 25), Scalar(0, 255, 0), 2);
-	}
-	else
-	{
-		line(frame, Point(x, y), Point(x, FRAME_HEIGHT), Scalar(0, 255, 0), 2);
-	}
-
-	if (x - 25 > 0)
-	{
-		line(frame, Point(x, y), Point(x - 25, y), Scalar(0, 255, 0), 2);
-	}
-	else
-	{
-		line(frame, Point(x, y), Point(0, y), Scalar(0, 255, 0), 2);
-	}
-
-	if (x + 25 < FRAME_WIDTH)
-	{
-		line(frame, Point(x, y), Point(x + 25, y), Scalar(0, 255, 0), 2);
-	}
-	else
-	{
-		line(frame, Point(x, y), Point(FRAME_WIDTH, y), Scalar(0, 255, 0), 2);
-	}
-
-	putText(frame, numToString(x) + "," + numToString(y), Point(x, y + 30), 1, 1, Scalar(0, 255, 0), 2);
-
-}
-
 // Color Filter Tracking
-void trackFilteredObject(Mat& threshold, Mat& cameraFeed)
+void trackFilteredObject(Mat& threshold, OverlaySnapshot& snapshot)
 {
 	Mat temp;
 	threshold.copyTo(temp); // OpenCV performs a shallow copy to save time and space; copyTo function creates a deep copy
@@ -127,20 +75,16 @@ void trackFilteredObject(Mat& threshold, Mat& cameraFeed)
 			//let user know you found an object
 			if (objectFound == true)
 			{
-				putText(cameraFeed, "Tracking Object", Point(0, 50), 2, 1, Scalar(0, 255, 0), 2);
-				//draw object location on screen
-				drawObject(x, y, cameraFeed);
-
-				for (int i = 0; i< contours.size(); i++)
-				{
-					Scalar color = Scalar(rng.uniform(0, 255), rng.uniform(0, 255), rng.uniform(0, 255));
-					drawContours(cameraFeed, contours, i, color, 2, 8, hierarchy, 0, Point());
-				}
+				snapshot.status = TRACKING;
+				//object location and contours are drawn by the renderer
+				snapshot.objects.push_back(OverlayObject(Point(x, y)));
+				snapshot.contours.swap(contours);
+				snapshot.hierarchy.swap(hierarchy);
 			}
 		}
 		else
 		{
-			putText(cameraFeed, "TOO MUCH NOISE! ADJUST FILTER", Point(0, 50), 1, 2, Scalar(0, 0, 255), 2);
+			snapshot.status = TOO_NOISY;
 		}
 	}
 }
@@ -165,12 +109,15 @@ void CannyThreshold(int, void*)
 	blur(imgGray, detected_edges, Size(3, 3));
 
 	// Canny detector
-	Canny(detected_edges, detected_edges, lowThreshold, lowThreshold*ratio, kernel_size);
+	int edgeThreshold = lowThreshold.value;
+	Canny(detected_edges, detected_edges, edgeThreshold, edgeThreshold*ratio, kernel_size);
 
 	// Using Canny's output as a mask, we display our result
 	Mat canny = Mat::zeros(imgOriginal.size(), imgOriginal.type());
 	imgOriginal.copyTo(canny, detected_edges);
-	imshow("Thresholded Image", canny); //show the thresholded image
+
+	OverlaySnapshot snapshot;
+	snapshot.images.push_back(make_pair(string("Thresholded Image"), canny)); //show the thresholded image
 
 	//these two vectors needed for output of findContours
 	vector< vector<Point> > contours;
@@ -179,7 +126,6 @@ void CannyThreshold(int, void*)
 	//find contours of filtered image using openCV findContours function
 	findContours(detected_edges.clone(), contours, hierarchy, CV_RETR_CCOMP, CV_CHAIN_APPROX_SIMPLE);
 	vector<Point> approx;
-	Mat dst = imgOriginal.clone();
 	for (int i = 0; i < contours.size(); i++)
 	{
 		approxPolyDP(Mat(contours[i]), approx, arcLength(Mat(contours[i]), true) * 0.01, true);
@@ -198,20 +144,25 @@ void CannyThreshold(int, void*)
 			{
 				int x = (int)(moment.m10 / area);
 				int y = (int)(moment.m01 / area);
-				drawObject(x, y, dst);
+				OverlayObject object(Point(x, y));
 
 				float wx, wy, wz = 0;
-				cap.distanceToPixel(x, y, wx, wy, wz);
-				putText(dst, numToString(wx) + "," + numToString(wy) + "," + numToString(wz), Point(0, 50), 1, 2, Scalar(0, 0, 255), 1);
+				if (cap.distanceToPixel(x, y, wx, wy, wz) == openni::STATUS_OK)
+				{
+					object.world = Point3f(wx, wy, wz);
+					object.hasWorld = true;
+				}
+				snapshot.objects.push_back(object);
 			}
 
-			line(dst, approx.at(0), approx.at(0), cvScalar(0, 0, 255), 4);
-			line(dst, approx.at(1), approx.at(1), cvScalar(0, 0, 255), 4);
-			line(dst, approx.at(2), approx.at(2), cvScalar(0, 0, 255), 4);
-			line(dst, approx.at(3), approx.at(3), cvScalar(0, 0, 255), 4);
+			snapshot.markers.insert(snapshot.markers.end(), approx.begin(), approx.end());
 		}
 	}
-	imshow("detected lines", dst);
+
+	// drawing happens on the render thread, the frame is dropped if the display is still busy
+	snapshot.frame = imgOriginal;
+	snapshot.frameWindow = "detected lines";
+	renderer.submit(snapshot);
 }
 
 
@@ -224,14 +175,20 @@ int main()
 	}
 	cap.registerDepthAndImage();
 
-	namedWindow("Control", CV_WINDOW_AUTOSIZE); //create a window called "Control"
+	// Windows live on the render thread so drawing and imshow never delay detection
+	renderer.start([]()
+	{
+		namedWindow("Control", CV_WINDOW_AUTOSIZE); //create a window called "Control"
 
-	//Create trackbars in "Control" window
-	cvCreateTrackbar("Threshold", "Control", &lowThreshold, maxLowThreshold);
+		//Create trackbars in "Control" window
+		lowThreshold.create("Threshold", "Control", maxLowThreshold);
+	});
 
-	while (waitKey(30) != 27) //wait for 'esc' key press for 30ms. If 'esc' key is pressed, break loop
+	while (!renderer.stopRequested()) //renderer flags the 'esc' key press
 	{
 		CannyThreshold(0, 0);
 	}
+	renderer.stop();
+	cout << "Overlay frames dropped: " << renderer.droppedFrames() << endl;
 	return 0;
 }
\ No newline at end of file